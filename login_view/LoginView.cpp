@@ -7,15 +7,33 @@
 #include <QPropertyAnimation>
 #include <QSequentialAnimationGroup>
 #include <QPainterPath>
+#include <QLoggingCategory>
+#include <QBuffer>
+#include <QFile>
 #ifdef QT_DEBUG
 #include <QDebug>
 #endif
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <QDBusConnection>
+#endif
+
+// 低功耗状态报告，默认关闭，用QT_LOGGING_RULES="login_view.power.info=true"打开
+Q_LOGGING_CATEGORY(lcPower, "login_view.power", QtWarningMsg)
 
 static int nScreenWidth = 0;
 static int nScreenHeight = 0;
 static int nDuration = 300; // 动画时间(单位ms)
+static int nIdleTimeout = 5 * 60 * 1000; // 默认无操作进入低功耗的时间(单位ms)
+
+#ifdef Q_OS_WIN
+// GUID_CONSOLE_DISPLAY_STATE，自行定义以免依赖SDK版本和uuid库
+static const GUID kDisplayStateGuid = { 0x6fe69556, 0x704a, 0x47a0, { 0x8f, 0x24, 0xc2, 0x8d, 0x93, 0x6f, 0xda, 0x47 } };
+#endif
 
-LoginView::LoginView(QWidget *parent) : QWidget(parent)
+LoginView::LoginView(QWidget *parent) : QWidget(parent), m_nIdleTimeout(nIdleTimeout)
 {
     nScreenWidth = QApplication::primaryScreen()->geometry().width();
     nScreenHeight = QApplication::primaryScreen()->geometry().height();
@@ -26,7 +44,10 @@ LoginView::LoginView(QWidget *parent) : QWidget(parent)
 
 LoginView::~LoginView()
 {
-
+#ifdef Q_OS_WIN
+    if(m_pPowerNotify)
+        UnregisterPowerSettingNotification(HPOWERNOTIFY(m_pPowerNotify));
+#endif
 }
 
 const SignInView *LoginView::GetSignInView() const
@@ -39,33 +60,289 @@ const SignUpView *LoginView::GetSignUpView() const
     return m_pLoginCard->GetSignUpView();
 }
 
+void LoginView::SetIdleTimeout(int msec)
+{
+    m_nIdleTimeout = msec;
+    if(!m_bLowPower)
+        RestartIdleTimer();
+}
+
+bool LoginView::IsLowPower() const
+{
+    return m_bLowPower;
+}
+
 void LoginView::Init()
 {
     setObjectName(QStringLiteral("login_view"));
     setStyleSheet(QStringLiteral("QWidget#login_view{border:none;}"));
-    m_backgroundPixmap.load(":/res/background.png");
-    m_backgroundPixmap = m_backgroundPixmap.scaled(nScreenWidth, nScreenHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
     m_pLoginCard = new LoginCard(this);
-    m_pLoginCard->GetOverlay()->SetPixmap(m_backgroundPixmap);
+    LoadBackground();
     m_pLoginCard->move( (width() - m_pLoginCard->width()) / 2,
                         (height() - m_pLoginCard->height()) / 2  );
 
     connect(GetSignInView(), &SignInView::Submitted, this, &LoginView::SignIn);
     connect(GetSignUpView(), &SignUpView::Submitted, this, &LoginView::SignUp);
+
+    // 空闲检测：任意输入都会重置计时，超时后进入低功耗
+    m_idleTimer.setSingleShot(true);
+    connect(&m_idleTimer, &QTimer::timeout, this, &LoginView::IdleTimeout);
+    m_retryTimer.setSingleShot(true);
+    m_retryTimer.setInterval(nDuration);
+    connect(&m_retryTimer, &QTimer::timeout, this, [&]{
+        // 延后期间可能已被唤醒或重新显示，需要再次确认
+        if(ShouldSleep())
+            EnterLowPower();
+    });
+    qApp->installEventFilter(this);
+    // 应用被隐藏或挂起时进入低功耗(移动平台)
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, [&](Qt::ApplicationState state){
+        if(state == Qt::ApplicationHidden || state == Qt::ApplicationSuspended)
+            EnterLowPower();
+    });
+    // 息屏检测：Windows在showEvent中注册显示器状态通知，Linux监听会话总线上的屏保信号
+#if defined(Q_OS_WIN)
+    qApp->installNativeEventFilter(this);
+#elif defined(Q_OS_LINUX)
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    bus.connect(QString(), QStringLiteral("/org/freedesktop/ScreenSaver"), QStringLiteral("org.freedesktop.ScreenSaver"),
+                QStringLiteral("ActiveChanged"), this, SLOT(ScreenSaverActiveChanged(bool)));
+    bus.connect(QString(), QStringLiteral("/org/gnome/ScreenSaver"), QStringLiteral("org.gnome.ScreenSaver"),
+                QStringLiteral("ActiveChanged"), this, SLOT(ScreenSaverActiveChanged(bool)));
+#endif
+    m_stateTimer.start();
     showFullScreen();
 }
 
+void LoginView::LoadBackground()
+{
+    QImage image;
+    if(m_backgroundData.isEmpty())
+    {
+        // 经QImage加载，不经过QPixmapCache，低功耗时清空m_backgroundPixmap即可真正释放
+        image.load(":/res/background.png");
+        if(image.size() != QSize(nScreenWidth, nScreenHeight))
+            image = image.scaled(nScreenWidth, nScreenHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        QBuffer buffer(&m_backgroundData);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+    }
+    else
+    {
+        image.loadFromData(m_backgroundData, "PNG");
+    }
+    m_backgroundPixmap = QPixmap::fromImage(image);
+    m_pLoginCard->GetOverlay()->SetPixmap(m_backgroundPixmap);
+}
+
+void LoginView::EnterLowPower()
+{
+    if(m_bLowPower)
+        return;
+    if(m_pLoginCard->GetOverlay()->IsAnimating())
+    {
+        // 切换动画未结束，等动画结束后再进入
+        m_retryTimer.start();
+        return;
+    }
+    Report("active");
+    m_bLowPower = true;
+    m_idleTimer.stop();
+    m_retryTimer.stop();
+    // 清除焦点以停止输入框的光标闪烁定时器
+    if(QWidget* focus = QApplication::focusWidget())
+        focus->clearFocus();
+    m_pLoginCard->SetLowPower(true);
+    m_backgroundPixmap = QPixmap();
+    update();
+}
+
+void LoginView::LeaveLowPower()
+{
+    m_retryTimer.stop();
+    if(m_bLowPower)
+    {
+        Report("low power");
+        m_bLowPower = false;
+        m_wakeTimer.start();
+        m_pLoginCard->SetLowPower(false);
+        update();
+    }
+    RestartIdleTimer();
+}
+
+bool LoginView::ShouldSleep() const
+{
+    Qt::ApplicationState state = QGuiApplication::applicationState();
+    return !isVisible() || m_bDisplayOff
+            || state == Qt::ApplicationHidden || state == Qt::ApplicationSuspended
+            || (m_nIdleTimeout > 0 && m_lastInput.elapsed() >= m_nIdleTimeout);
+}
+
+void LoginView::SetDisplayOff(bool off)
+{
+    m_bDisplayOff = off;
+    if(off)
+        EnterLowPower();
+    else if(isVisible())
+        LeaveLowPower();
+}
+
+void LoginView::ScreenSaverActiveChanged(bool active)
+{
+    SetDisplayOff(active);
+}
+
+void LoginView::RestartIdleTimer()
+{
+    m_lastInput.restart();
+    if(m_nIdleTimeout > 0 && isVisible())
+        m_idleTimer.start(m_nIdleTimeout);
+    else
+        m_idleTimer.stop();
+}
+
+void LoginView::IdleTimeout()
+{
+    qint64 remaining = m_nIdleTimeout - m_lastInput.elapsed();
+    if(remaining > 0)
+        m_idleTimer.start(int(remaining));
+    else
+        EnterLowPower();
+}
+
+void LoginView::Report(const char *state)
+{
+    qint64 elapsed = m_stateTimer.restart();
+    qint64 wakeups = m_nWakeups;
+    m_nWakeups = 0;
+    if(!lcPower().isInfoEnabled())
+        return;
+    qint64 pixmapBytes = qint64(m_backgroundPixmap.width()) * m_backgroundPixmap.height() * m_backgroundPixmap.depth() / 8;
+    QByteArray rss = "unknown";
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        rss = QByteArray::number(qulonglong(counters.WorkingSetSize / 1024)) + " kB";
+#elif defined(Q_OS_LINUX)
+    QFile status(QStringLiteral("/proc/self/status"));
+    if(status.open(QIODevice::ReadOnly))
+    {
+        for(const QByteArray& line : status.readAll().split('\n'))
+        {
+            if(line.startsWith("VmRSS:"))
+                rss = line.mid(6).trimmed();
+        }
+    }
+#endif
+    qCInfo(lcPower) << "state" << state << "lasted" << elapsed << "ms"
+                    << " rss:" << rss.constData()
+                    << " background pixmap bytes:" << pixmapBytes
+                    << " compressed background bytes:" << m_backgroundData.size()
+                    << " timer wakeups/s:" << (elapsed > 0 ? wakeups * 1000.0 / elapsed : 0.0);
+}
+
 void LoginView::paintEvent(QPaintEvent *event)
 {
+    // 唤醒后延迟到第一次绘制时再重建背景，输入事件可立即返回
+    if(!m_bLowPower && m_backgroundPixmap.isNull())
+    {
+        LoadBackground();
+        if(m_wakeTimer.isValid())
+        {
+            qCInfo(lcPower) << "background rebuilt" << m_wakeTimer.elapsed() << "ms after wake";
+            m_wakeTimer.invalidate();
+        }
+    }
     QStyleOption opt;
     opt.init(this);
     QPainter p(this);
     p.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
     style()->drawPrimitive(QStyle::PE_Widget, &opt, &p, this);
-    p.drawPixmap(0, 0, m_backgroundPixmap);
+    if(m_bLowPower)
+        p.fillRect(rect(), Qt::black);
+    else
+        p.drawPixmap(0, 0, m_backgroundPixmap);
     QWidget::paintEvent(event);
 }
 
+void LoginView::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+#ifdef Q_OS_WIN
+    // 注册后系统会立即发送一次当前的显示器状态
+    if(!m_pPowerNotify)
+        m_pPowerNotify = RegisterPowerSettingNotification(HWND(window()->winId()), &kDisplayStateGuid, DEVICE_NOTIFY_WINDOW_HANDLE);
+#endif
+    LeaveLowPower();
+}
+
+void LoginView::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    EnterLowPower();
+}
+
+bool LoginView::eventFilter(QObject *watched, QEvent *event)
+{
+    if(event->type() == QEvent::Timer)
+    {
+        if(lcPower().isInfoEnabled())
+            ++m_nWakeups;
+        return QWidget::eventFilter(watched, event);
+    }
+
+    // 只处理本控件及其子控件的输入，LoginView也可能嵌入在其他窗口中
+    if(!watched->isWidgetType()
+            || (watched != this && !isAncestorOf(static_cast<QWidget*>(watched))))
+        return QWidget::eventFilter(watched, event);
+
+    switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+        if(m_bLowPower)
+        {
+            // 唤醒用的输入不再向下传递，避免误触
+            LeaveLowPower();
+            return true;
+        }
+        // 只记录时间，计时器到期时再按剩余时间重新计时，避免每次输入都重新注册定时器
+        m_lastInput.restart();
+        break;
+    default:
+        break;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+bool LoginView::nativeEventFilter(const QByteArray &eventType, void *message, long *result)
+{
+    Q_UNUSED(result)
+#ifdef Q_OS_WIN
+    MSG* msg = static_cast<MSG*>(message);
+    if(eventType == "windows_generic_MSG" && msg->message == WM_POWERBROADCAST && msg->wParam == PBT_POWERSETTINGCHANGE)
+    {
+        const POWERBROADCAST_SETTING* setting = reinterpret_cast<const POWERBROADCAST_SETTING*>(msg->lParam);
+        // Data[0]：0关闭，1打开，2变暗
+        if(IsEqualGUID(setting->PowerSetting, kDisplayStateGuid))
+            SetDisplayOff(setting->Data[0] == 0);
+    }
+#else
+    Q_UNUSED(eventType)
+    Q_UNUSED(message)
+#endif
+    return false;
+}
+
 void LoginView::SignIn(const QString user, const QString pwd)
 {
     // TODO: 执行登录的操作
@@ -105,6 +382,24 @@ LoginOverlay *LoginCard::GetOverlay() const
     return m_pOverlay;
 }
 
+void LoginCard::SetLowPower(bool lowPower)
+{
+    if(lowPower)
+    {
+        m_pSignInView->Clear();
+        m_pSignUpView->Clear();
+        hide();
+        // 删除阴影效果，同时释放其离屏缓存
+        setGraphicsEffect(nullptr);
+        m_pOverlay->SetPixmap(QPixmap());
+    }
+    else
+    {
+        InitShadow();
+        show();
+    }
+}
+
 void LoginCard::Init()
 {
     setObjectName(QStringLiteral("login_card"));
@@ -162,12 +457,17 @@ void LoginCard::Init()
         an->start();
     });
 
+    InitShadow();
+    setContentsMargins(1,1,1,1);
+}
+
+void LoginCard::InitShadow()
+{
     QGraphicsDropShadowEffect *shadow = new QGraphicsDropShadowEffect(this);
     shadow->setOffset(0, 0);
     shadow->setColor(Qt::gray);
     shadow->setBlurRadius(30);
     setGraphicsEffect(shadow);
-    setContentsMargins(1,1,1,1);
 }
 
 void LoginCard::paintEvent(QPaintEvent *event)
@@ -200,6 +500,11 @@ void LoginOverlay::SetPixmap(const QPixmap &pixmap)
     m_backgroundPixmap = pixmap;
 }
 
+bool LoginOverlay::IsAnimating() const
+{
+    return m_bAni;
+}
+
 void LoginOverlay::Init()
 {
     setObjectName(QStringLiteral("login_overlay"));
@@ -6,6 +6,9 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QAbstractNativeEventFilter>
 
 class LoginCard;
 class LoginOverlay;
@@ -19,7 +22,7 @@ enum class LoginStatus
 };
 
 // 装载LoginCard
-class LoginView : public QWidget
+class LoginView : public QWidget, public QAbstractNativeEventFilter
 {
     Q_OBJECT
 public:
@@ -27,14 +30,87 @@ public:
     ~LoginView();
     const SignInView* GetSignInView() const;
     const SignUpView* GetSignUpView() const;
+
+    /**
+     * @brief SetIdleTimeout 设置无操作多久后进入低功耗模式
+     * @param msec 超时时间(单位ms)，<=0表示不因空闲进入低功耗
+     */
+    void SetIdleTimeout(int msec);
+    bool IsLowPower() const;
 protected:
     void Init();
     void paintEvent(QPaintEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+    /**
+     * @brief nativeEventFilter Windows下接收WM_POWERBROADCAST，检测显示器关闭/打开
+     */
+    bool nativeEventFilter(const QByteArray& eventType, void* message, long* result) override;
     void SignIn(const QString user, const QString pwd);
     void SignUp(const QString nickName, const QString user, const QString pwd);
+
+    /**
+     * @brief LoadBackground 加载背景图片，首次加载时缩放到屏幕大小并压缩保存，之后只需解码
+     */
+    void LoadBackground();
+
+    /**
+     * @brief EnterLowPower 进入低功耗模式：停止动画和光标闪烁，释放大图和阴影缓存，不再有定时器唤醒
+     */
+    void EnterLowPower();
+
+    /**
+     * @brief LeaveLowPower 退出低功耗模式，背景图片在下一次绘制时重建
+     */
+    void LeaveLowPower();
+
+    /**
+     * @brief ShouldSleep 当前是否满足进入低功耗的条件(隐藏、息屏、应用挂起或空闲超时)
+     */
+    bool ShouldSleep() const;
+
+    /**
+     * @brief SetDisplayOff 显示器关闭时进入低功耗，打开时恢复
+     */
+    void SetDisplayOff(bool off);
+
+    /**
+     * @brief RestartIdleTimer 从当前时刻重新开始空闲计时
+     */
+    void RestartIdleTimer();
+
+    /**
+     * @brief IdleTimeout 空闲计时到期，期间有过输入则按剩余时间重新计时
+     */
+    void IdleTimeout();
+
+    /**
+     * @brief Report 输出上一个状态的常驻内存、背景图片大小和每秒定时器唤醒次数，
+     *        由日志分类login_view.power控制，例如QT_LOGGING_RULES="login_view.power.info=true"
+     * @param state 上一个状态的名称
+     */
+    void Report(const char* state);
+private slots:
+    /**
+     * @brief ScreenSaverActiveChanged Linux下会话总线屏保状态改变
+     */
+    void ScreenSaverActiveChanged(bool active);
 private:
     LoginCard* m_pLoginCard;
     QPixmap m_backgroundPixmap;
+    QByteArray m_backgroundData; // 已缩放到屏幕大小的背景图片(PNG压缩)
+    QTimer m_idleTimer;
+    QTimer m_retryTimer; // 动画未结束时延后进入低功耗
+    QElapsedTimer m_lastInput; // 距上次输入的时间
+    QElapsedTimer m_stateTimer; // 当前状态持续的时间
+    QElapsedTimer m_wakeTimer; // 唤醒到背景重建完成的时间
+    qint64 m_nWakeups = 0;
+    int m_nIdleTimeout;
+    bool m_bLowPower = false;
+    bool m_bDisplayOff = false;
+    void* m_pPowerNotify = nullptr; // Windows下的HPOWERNOTIFY
 };
 
 // 装载LoginOverlay + SignInView + SignUpView
@@ -47,8 +123,18 @@ public:
     const SignInView* GetSignInView() const;
     const SignUpView* GetSignUpView() const;
     LoginOverlay* GetOverlay() const;
+
+    /**
+     * @brief SetLowPower 低功耗时隐藏卡片并释放阴影和图层图片，恢复时重建阴影
+     */
+    void SetLowPower(bool lowPower);
 protected:
     void Init();
+
+    /**
+     * @brief InitShadow 创建卡片的阴影效果
+     */
+    void InitShadow();
     void paintEvent(QPaintEvent* event) override;
 private:
     SignInView* m_pSignInView;
@@ -64,6 +150,7 @@ public:
     explicit LoginOverlay(QWidget* parent = nullptr);
     ~LoginOverlay();
     void SetPixmap(const QPixmap& pixmap);
+    bool IsAnimating() const;
 protected:
     void Init();
     void paintEvent(QPaintEvent* event) override;
@@ -22,5 +22,10 @@ qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
+# 低功耗报告用GetProcessMemoryInfo输出常驻内存
+win32: LIBS += -lpsapi
+# 通过会话总线的屏保信号检测息屏
+linux: QT += dbus
+
 RESOURCES += \
     login_view.qrc